@@ -0,0 +1,212 @@
+#ifndef DINOPHYSICS_H
+#define DINOPHYSICS_H
+
+// Simulation constants and jump geometry shared by the game and the
+// offline JumpCheck validator. Everything here is plain C++ so it can be
+// evaluated at compile time.
+
+namespace DinoPhysics {
+
+// Simulation
+constexpr int TICK_MS = 16;
+constexpr float INITIAL_GAME_SPEED = 5.0f;
+constexpr float MAX_GAME_SPEED = 15.0f;
+constexpr float SPEED_INCREMENT = 0.5f;
+constexpr float CACTUS_SPEED_FACTOR = 0.8f;
+constexpr float GRAVITY = 0.8f;
+constexpr float JUMP_VELOCITY = -15.0f;
+
+// The first step after a jump only integrates the part of a tick left after
+// the key press. The game loop runs up to an eighth of a tick ahead of the
+// wall clock, so a press can also be applied one tick late with the missed
+// time added to that step: it covers between 0 and MAX_FIRST_STEP ticks.
+constexpr float MAX_FIRST_STEP = 1.125f;
+
+// Dino geometry. At rest the top of the dino sits DINO_BASE_OFFSET above
+// the ground line; its hitbox is inset from the drawn body.
+constexpr int DINO_WIDTH = 60;
+constexpr int DINO_HEIGHT = 60;
+constexpr int DINO_BASE_OFFSET = 50;
+constexpr int DINO_HITBOX_INSET_X = 8;
+constexpr int DINO_HITBOX_INSET_TOP = 8;
+constexpr int DINO_HITBOX_INSET_BOTTOM = 4;
+
+// Cactus geometry, indexed by Cactus::type
+constexpr int CACTUS_TYPES = 4;
+constexpr int CACTUS_HITBOX_INSET = 2;
+
+struct CactusSize {
+    int width, height;
+};
+
+constexpr CactusSize CACTUS_SIZES[CACTUS_TYPES] = {
+    { 20, 45 }, // small single
+    { 25, 65 }, // medium single
+    { 30, 80 }, // large single
+    { 45, 60 }, // double
+};
+
+// Pixels the cacti move per tick at a given game speed
+constexpr int cactusStep(float gameSpeed)
+{
+    return static_cast<int>(gameSpeed * CACTUS_SPEED_FACTOR);
+}
+
+// Jump arc as simulated by DinoRunGame::updateDino(): lift[t] is the
+// height above the resting position t ticks after the jump key, until the
+// dino lands again at tick airTicks. firstStep is the share of a tick
+// integrated on the tick the jump is applied.
+constexpr int MAX_AIR_TICKS = 64;
+constexpr int MAX_LIFT = 256;
+
+struct JumpArc {
+    int lift[MAX_AIR_TICKS + 1];
+    int airTicks;
+    int apex;
+};
+
+constexpr JumpArc computeJumpArc(float firstStep = 1.0f)
+{
+    JumpArc arc{};
+    float velocity = JUMP_VELOCITY;
+    float step = firstStep;
+    int y = 0;
+    int tick = 0;
+
+    // The dino only lands once it is falling, a short first step may not
+    // lift it at all
+    do {
+        velocity += GRAVITY * step;
+        y += static_cast<int>(velocity * step);
+        step = 1.0f;
+        ++tick;
+        arc.lift[tick] = y < 0 ? -y : 0;
+        if (arc.lift[tick] > arc.apex) {
+            arc.apex = arc.lift[tick];
+        }
+    } while ((y < 0 || velocity <= 0.0f) && tick < MAX_AIR_TICKS);
+
+    arc.airTicks = tick;
+    return arc;
+}
+
+constexpr JumpArc JUMP_ARC = computeJumpArc();
+
+static_assert(JUMP_ARC.lift[JUMP_ARC.airTicks] == 0, "jump must land within MAX_AIR_TICKS");
+static_assert(JUMP_ARC.apex < MAX_LIFT, "jump apex exceeds the clearance table");
+
+// For every lift, the ticks after takeoff during which the dino is at least
+// that high. The arc is unimodal, so this is one contiguous window; it is
+// empty (first > last) above the apex.
+struct ClearanceWindow {
+    int first, last;
+};
+
+struct ClearanceEnvelope {
+    ClearanceWindow window[MAX_LIFT];
+};
+
+constexpr ClearanceEnvelope computeClearanceEnvelope()
+{
+    ClearanceEnvelope envelope{};
+    for (int lift = 0; lift < MAX_LIFT; ++lift) {
+        envelope.window[lift] = ClearanceWindow{ 1, 0 };
+        for (int tick = 1; tick < JUMP_ARC.airTicks; ++tick) {
+            if (JUMP_ARC.lift[tick] >= lift) {
+                if (envelope.window[lift].first > envelope.window[lift].last) {
+                    envelope.window[lift].first = tick;
+                }
+                envelope.window[lift].last = tick;
+            }
+        }
+    }
+    return envelope;
+}
+
+constexpr ClearanceEnvelope CLEARANCE = computeClearanceEnvelope();
+
+constexpr ClearanceWindow clearanceWindow(int lift)
+{
+    return lift < MAX_LIFT ? CLEARANCE.window[lift < 0 ? 0 : lift] : ClearanceWindow{ 1, 0 };
+}
+
+// An obstacle as the jump sees it: the lift needed for the hitboxes to
+// miss vertically, and the horizontal distance over which they overlap
+struct Obstacle {
+    int lift;
+    int span;
+};
+
+constexpr Obstacle cactusObstacle(int type)
+{
+    const CactusSize size = CACTUS_SIZES[type];
+    const int dinoRestingBottom = DINO_HEIGHT - DINO_BASE_OFFSET - DINO_HITBOX_INSET_BOTTOM;
+    return Obstacle{
+        dinoRestingBottom + size.height - CACTUS_HITBOX_INSET,
+        (DINO_WIDTH - 2 * DINO_HITBOX_INSET_X) + (size.width - 2 * CACTUS_HITBOX_INSET)
+    };
+}
+
+constexpr int ceilDiv(int value, int divisor)
+{
+    return (value + divisor - 1) / divisor;
+}
+
+// Whether a single obstacle can be jumped when cacti move step px per tick
+constexpr bool canClear(const Obstacle &obstacle, int step)
+{
+    const ClearanceWindow window = clearanceWindow(obstacle.lift);
+    return window.last - window.first + 1 >= ceilDiv(obstacle.span, step);
+}
+
+// Whether next can still be cleared after prev, with distance px between
+// their leading edges. Either the dino jumps prev as early as possible,
+// lands and jumps again in time for next, or one jump covers both.
+constexpr bool isFairFollowUp(const Obstacle &prev, const Obstacle &next, int distance, int step)
+{
+    if (!canClear(prev, step) || !canClear(next, step)) {
+        return false;
+    }
+
+    const ClearanceWindow prevWindow = clearanceWindow(prev.lift);
+    const ClearanceWindow nextWindow = clearanceWindow(next.lift);
+    const int earliestLanding = ceilDiv(prev.span, step) - 1 - prevWindow.last + JUMP_ARC.airTicks;
+    if (earliestLanding + nextWindow.first <= distance / step) {
+        return true;
+    }
+
+    const ClearanceWindow bothWindow =
+            clearanceWindow(prev.lift > next.lift ? prev.lift : next.lift);
+    return ceilDiv(distance, step) + ceilDiv(next.span, step) - 1
+            <= bothWindow.last - bothWindow.first;
+}
+
+// Whether every cactus type can be cleared on its own with the given arc.
+// The clearance window of an arc is contiguous, so counting the ticks above
+// the obstacle is enough.
+constexpr bool allCactiClearable(const JumpArc &arc, int step)
+{
+    for (int type = 0; type < CACTUS_TYPES; ++type) {
+        const Obstacle obstacle = cactusObstacle(type);
+        int ticksAbove = 0;
+        for (int tick = 1; tick < arc.airTicks; ++tick) {
+            if (arc.lift[tick] >= obstacle.lift) {
+                ++ticksAbove;
+            }
+        }
+        if (ticksAbove < ceilDiv(obstacle.span, step)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A smaller step leaves more ticks above the cactus, so the slowest speed
+// is the binding case. Arcs with a partial first step are checked by
+// JumpCheck, the sweep is too expensive for every compile.
+static_assert(allCactiClearable(JUMP_ARC, cactusStep(INITIAL_GAME_SPEED)),
+              "cactus unclearable at the initial speed");
+
+} // namespace DinoPhysics
+
+#endif // DINOPHYSICS_H
@@ -1,4 +1,5 @@
 #include "DinoRunGame.h"
+#include <algorithm>
 #include <cmath>
 
 DinoRunGame::DinoRunGame(QWidget *parent)
@@ -10,24 +11,47 @@ DinoRunGame::DinoRunGame(QWidget *parent)
     , isNewHighScore(false)
     , lastCactusTime(0)
     , lastCloudTime(0)
-    , lastTreeTime(0)
     , updateTimer(nullptr)
+    , renderScale(1.0)
+    , autoRenderScale(true)
+    , averageFrameMs(0.0)
+    , traceWriter(nullptr)
+    , tickCount(0)
+    , assetThread(nullptr)
+    , preparedScale(0.0)
+    , preparedHighScore(0)
+    , tileScale(0.0)
+    , highScoreLoaded(false)
+    , firstFrameMs(-1)
+    , assetsReadyMs(-1)
+    , benchmarkEnabled(false)
+    , simTime(0)
+    , frameCapture(nullptr)
+    , captureFrameLimit(0)
+    , captureFast(false)
+    , simClockNs(0)
 {
-    // Set window properties
-    setFixedSize(GAME_WIDTH, GAME_HEIGHT + GROUND_HEIGHT);
-    setWindowTitle("Dino Run Game - Qt Creator");
+    startupTimer.start();
 
-    // Load high score from file
-    loadHighScore();
+    // Set window properties. The scene is drawn in GAME_WIDTH x VIEW_HEIGHT
+    // logical coordinates and scaled to whatever size the window has.
+    resize(GAME_WIDTH, VIEW_HEIGHT);
+    setMinimumSize(GAME_WIDTH / 2, VIEW_HEIGHT / 2);
+    setWindowTitle("Dino Run Game - Qt Creator");
 
-    // Initialize game elements
+    // Initialize game elements. Everything here is cheap; the layer tiles
+    // and the stored high score are prepared in the background so the first
+    // frame can be shown straight away.
     initializeDino();
     initializeMountains();
+    initializeLayers();
     initializeGame();
+    prepareAssets();
 
     // Setup game timer
     updateTimer = new QTimer(this);
-    updateTimer->setInterval(16); // ~60 FPS
+    updateTimer->setInterval(TICK_MS); // ~60 FPS
+    updateTimer->setTimerType(Qt::PreciseTimer);
     connect(updateTimer, &QTimer::timeout, this, &DinoRunGame::gameLoop);
 
     // Start game timer
@@ -39,18 +63,134 @@ DinoRunGame::DinoRunGame(QWidget *parent)
         clouds.last().x = QRandomGenerator::global()->bounded(GAME_WIDTH - 100, GAME_WIDTH + 50);
     }
 
-    // Generate initial trees
-    for (int i = 0; i < 3; ++i) {
-        generateTree();
-    }
-
     setFocusPolicy(Qt::StrongFocus);
     setFocus();
 }
 
 DinoRunGame::~DinoRunGame()
 {
-    // Timer is automatically deleted by Qt's parent-child system
+    // Timer is automatically deleted by Qt's parent-child system, but a
+    // running asset thread has to finish before it can be destroyed
+    if (assetThread) {
+        assetThread->wait();
+    }
+
+    // Flushes the frames still queued for encoding
+    delete frameCapture;
+
+    if (benchmarkEnabled) {
+        printBenchmark();
+    }
+}
+
+bool DinoRunGame::startCapture(const QString &directory, FrameCapture::Format format,
+                               int frameLimit, bool fast)
+{
+    // Pin the scale so every frame has the same size and can reuse the tiles
+    setRenderScale(renderScale);
+
+    const QSize frameSize(qRound(GAME_WIDTH * renderScale), qRound(VIEW_HEIGHT * renderScale));
+    frameCapture = new FrameCapture(frameSize, CAPTURE_POOL_SIZE);
+    if (!frameCapture->start(directory, format, QThread::idealThreadCount() - 1)) {
+        delete frameCapture;
+        frameCapture = nullptr;
+        return false;
+    }
+
+    captureFrameLimit = frameLimit;
+    captureFast = fast;
+
+    if (captureFast) {
+        // Simulation time is decoupled from the wall clock, so ticks can run
+        // back to back; the encoders' backpressure is the only throttle
+        updateTimer->setInterval(0);
+        gameState = PLAYING;
+        recordTrace(TRACE_START);
+        updateTimer->start();
+    }
+    return true;
+}
+
+void DinoRunGame::captureFrame()
+{
+    // Only a fast capture may wait for the encoders; a live one must not
+    // stall input and painting, so it skips frames the encoders cannot take
+    QImage *frame = captureFast ? frameCapture->acquireFrame() : frameCapture->tryAcquireFrame();
+    if (!frame) {
+        return;
+    }
+
+    {
+        QPainter painter(frame);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.scale(renderScale, renderScale);
+        renderFrame(painter);
+    }
+    frameCapture->submitFrame(frame);
+
+    if (captureFrameLimit > 0 && frameCapture->framesSubmitted() >= captureFrameLimit) {
+        stopCapture();
+    }
+}
+
+void DinoRunGame::stopCapture()
+{
+    frameCapture->finish();
+    qInfo("Captured %d frames (%d failed, %d dropped)", frameCapture->framesSubmitted(),
+          frameCapture->framesFailed(), frameCapture->framesDropped());
+
+    delete frameCapture;
+    frameCapture = nullptr;
+
+    if (captureFast) {
+        captureFast = false;
+        updateTimer->stop();
+        close();
+    }
+}
+
+void DinoRunGame::setBenchmark(bool enabled)
+{
+    benchmarkEnabled = enabled;
+}
+
+void DinoRunGame::printBenchmark() const
+{
+    qInfo("time to first frame: %lld ms", firstFrameMs);
+    qInfo("assets ready:        %lld ms", assetsReadyMs);
+    qInfo("average paint:       %.2f ms at render scale %.2f", averageFrameMs, renderScale);
+
+    if (!inputLatenciesNs.isEmpty()) {
+        QVector<qint64> sorted = inputLatenciesNs;
+        std::sort(sorted.begin(), sorted.end());
+        const auto percentile = [&sorted](double p) {
+            return sorted.at(static_cast<int>(p * (sorted.size() - 1))) / 1.0e6;
+        };
+        qInfo("input to frame:      p50 %.2f ms, p99 %.2f ms over %d jumps",
+              percentile(0.5), percentile(0.99), static_cast<int>(sorted.size()));
+    }
+}
+
+bool DinoRunGame::startTrace(const QString &fileName)
+{
+    if (!traceWriter) {
+        traceWriter = new TraceWriter(this);
+    }
+    return traceWriter->open(fileName);
+}
+
+void DinoRunGame::setRenderScale(qreal scale)
+{
+    // Whole steps keep the parallax strips an exact number of pixels wide
+    autoRenderScale = false;
+    renderScale = qBound(MIN_RENDER_SCALE, qRound(scale / RENDER_SCALE_STEP) * RENDER_SCALE_STEP,
+                         MAX_RENDER_SCALE);
+
+    // The back buffer and every strip grow with the square of the scale
+    if (scale > MAX_RENDER_SCALE) {
+        qWarning("Render scale %.2f is too large, using %.2f", scale, renderScale);
+    }
+    update();
 }
 
 // Initialization Methods
@@ -58,24 +198,24 @@ void DinoRunGame::initializeGame()
 {
     cacti.clear();
     clouds.clear();
-    trees.clear();
 
     score = 0;
+    tickCount = 0;
     gameSpeed = INITIAL_GAME_SPEED;
-    lastCactusTime = gameTimer.elapsed();
-    lastCloudTime = gameTimer.elapsed();
-    lastTreeTime = gameTimer.elapsed();
+    lastCactusTime = simTime;
+    lastCloudTime = simTime;
     isNewHighScore = false;
 }
 
 void DinoRunGame::initializeDino()
 {
     dino.x = 80;
-    dino.baseY = GAME_HEIGHT - GROUND_HEIGHT - 50;
+    dino.baseY = GAME_HEIGHT - GROUND_HEIGHT - DinoPhysics::DINO_BASE_OFFSET;
     dino.y = dino.baseY;
-    dino.width = 60;
-    dino.height = 60;
+    dino.width = DinoPhysics::DINO_WIDTH;
+    dino.height = DinoPhysics::DINO_HEIGHT;
     dino.velocity = 0.0f;
+    dino.stepFraction = 1.0f;
     dino.state = RUNNING;
     dino.frame = 0;
     dino.animationTimer = 0;
@@ -87,6 +227,32 @@ void DinoRunGame::initializeMountains()
     mountains[1] = Mountain{200, 280, 160, false};
     mountains[2] = Mountain{420, 270, 140, false};
     mountains[3] = Mountain{550, 380, 200, true};
+
+    // Hills and the tree line are spread evenly over one strip width so the
+    // wrap-around seam is not noticeable
+    for (int i = 0; i < HILL_COUNT; ++i) {
+        hills[i].x = i * (GAME_WIDTH / HILL_COUNT) + QRandomGenerator::global()->bounded(40);
+        hills[i].width = 180 + QRandomGenerator::global()->bounded(80);
+        hills[i].height = 70 + QRandomGenerator::global()->bounded(40);
+        hills[i].isBig = hills[i].height > 90;
+    }
+
+    for (int i = 0; i < TREE_LINE_COUNT; ++i) {
+        treeLine[i] = generateTree(i * (GAME_WIDTH / TREE_LINE_COUNT)
+                                   + QRandomGenerator::global()->bounded(30));
+    }
+}
+
+void DinoRunGame::initializeLayers()
+{
+    const int groundY = GAME_HEIGHT - GROUND_HEIGHT;
+
+    // Strip heights cover the tallest shape of each layer. The tiles
+    // themselves are rendered by prepareAssets() on a worker thread.
+    layers[FAR_MOUNTAINS] = ParallaxLayer{QPixmap(), GAME_HEIGHT - 220, 220, 0.03f, 0.0f};
+    layers[NEAR_HILLS] = ParallaxLayer{QPixmap(), groundY - 110, 110, 0.08f, 0.0f};
+    layers[TREE_LINE] = ParallaxLayer{QPixmap(), groundY - 110, 110, 0.15f, 0.0f};
+    layers[GROUND_TEXTURE] = ParallaxLayer{QPixmap(), groundY - 2, GROUND_HEIGHT + 2, 0.8f, 0.0f};
 }
 
 // Update Methods
@@ -96,10 +262,15 @@ void DinoRunGame::updateDino()
     dino.frame = static_cast<int>(dino.animationTimer) % 4;
 
     if (dino.state == JUMPING) {
-        dino.velocity += GRAVITY;
-        dino.y += static_cast<int>(dino.velocity);
-
-        if (dino.y >= dino.baseY) {
+        // The first step after a jump only covers the time since the key
+        // was pressed
+        dino.velocity += GRAVITY * dino.stepFraction;
+        dino.y += static_cast<int>(dino.velocity * dino.stepFraction);
+        dino.stepFraction = 1.0f;
+
+        // Land only once falling; a press late in a tick may not leave the
+        // ground on its first step
+        if (dino.velocity > 0.0f && dino.y >= dino.baseY) {
             dino.y = dino.baseY;
             dino.velocity = 0.0f;
             dino.state = RUNNING;
@@ -111,7 +282,7 @@ void DinoRunGame::updateCacti()
 {
     // Update existing cacti
     for (int i = cacti.size() - 1; i >= 0; --i) {
-        cacti[i].x -= static_cast<int>(gameSpeed * 0.8f);
+        cacti[i].x -= DinoPhysics::cactusStep(gameSpeed);
 
         if (cacti[i].x + cacti[i].width < 0) {
             cacti.removeAt(i);
@@ -124,10 +295,11 @@ void DinoRunGame::updateCacti()
         }
     }
 
-    // Generate new cactus
-    qint64 currentTime = gameTimer.elapsed();
-    if (currentTime - lastCactusTime > 1200 + QRandomGenerator::global()->bounded(1800)) {
-        generateCactus();
+    // Generate new cactus. An unfair spawn is retried on the next tick,
+    // when the gap to the previous cactus has grown.
+    qint64 currentTime = simTime;
+    if (currentTime - lastCactusTime > 1200 + QRandomGenerator::global()->bounded(1800)
+        && generateCactus()) {
         lastCactusTime = currentTime;
     }
 }
@@ -143,27 +315,24 @@ void DinoRunGame::updateClouds()
         }
     }
 
-    qint64 currentTime = gameTimer.elapsed();
+    qint64 currentTime = simTime;
     if (currentTime - lastCloudTime > 3000 + QRandomGenerator::global()->bounded(3000)) {
         generateCloud();
         lastCloudTime = currentTime;
     }
 }
 
-void DinoRunGame::updateTrees()
+void DinoRunGame::updateLayers()
 {
-    for (int i = trees.size() - 1; i >= 0; --i) {
-        trees[i].x -= static_cast<int>(gameSpeed * 0.15f);
+    for (int i = 0; i < LAYER_COUNT; ++i) {
+        float step = gameSpeed * layers[i].speed;
 
-        if (trees[i].x + trees[i].width < 0) {
-            trees.removeAt(i);
+        // Cacti move in whole pixels, keep the ground texture in lockstep
+        if (i == GROUND_TEXTURE) {
+            step = std::floor(step);
         }
-    }
 
-    qint64 currentTime = gameTimer.elapsed();
-    if (currentTime - lastTreeTime > 4000 + QRandomGenerator::global()->bounded(2000)) {
-        generateTree();
-        lastTreeTime = currentTime;
+        layers[i].offset = std::fmod(layers[i].offset + step, static_cast<float>(GAME_WIDTH));
     }
 }
 
@@ -191,33 +360,42 @@ void DinoRunGame::checkCollisions()
 }
 
 // Generation Methods
-void DinoRunGame::generateCactus()
+bool DinoRunGame::generateCactus()
 {
-    Cactus cactus;
-    cactus.type = QRandomGenerator::global()->bounded(4);
+    const int step = DinoPhysics::cactusStep(gameSpeed);
+    const int rolledType = QRandomGenerator::global()->bounded(DinoPhysics::CACTUS_TYPES);
+
+    // Keep the rolled type if the dino can get past it, otherwise fall back
+    // to the next type that fits the gap
+    for (int i = 0; i < DinoPhysics::CACTUS_TYPES; ++i) {
+        const int type = (rolledType + i) % DinoPhysics::CACTUS_TYPES;
+        if (!isFairSpawn(type, step)) {
+            continue;
+        }
 
-    switch (cactus.type) {
-    case 0: // Small single
-        cactus.width = 20;
-        cactus.height = 45;
-        break;
-    case 1: // Medium single
-        cactus.width = 25;
-        cactus.height = 65;
-        break;
-    case 2: // Large single
-        cactus.width = 30;
-        cactus.height = 80;
-        break;
-    case 3: // Double cactus
-        cactus.width = 45;
-        cactus.height = 60;
-        break;
+        Cactus cactus;
+        cactus.type = type;
+        cactus.width = DinoPhysics::CACTUS_SIZES[type].width;
+        cactus.height = DinoPhysics::CACTUS_SIZES[type].height;
+        cactus.y = GAME_HEIGHT - GROUND_HEIGHT - cactus.height;
+        cactus.x = GAME_WIDTH;
+        cacti.append(cactus);
+        return true;
     }
 
-    cactus.y = GAME_HEIGHT - GROUND_HEIGHT - cactus.height;
-    cactus.x = GAME_WIDTH;
-    cacti.append(cactus);
+    return false;
+}
+
+bool DinoRunGame::isFairSpawn(int type, int step) const
+{
+    const DinoPhysics::Obstacle candidate = DinoPhysics::cactusObstacle(type);
+    if (cacti.isEmpty()) {
+        return DinoPhysics::canClear(candidate, step);
+    }
+
+    const Cactus &previous = cacti.last();
+    return DinoPhysics::isFairFollowUp(DinoPhysics::cactusObstacle(previous.type), candidate,
+                                       GAME_WIDTH - previous.x, step);
 }
 
 void DinoRunGame::generateCloud()
@@ -230,7 +408,7 @@ void DinoRunGame::generateCloud()
     clouds.append(cloud);
 }
 
-void DinoRunGame::generateTree()
+DinoRunGame::Tree DinoRunGame::generateTree(int x)
 {
     Tree tree;
     tree.isBig = QRandomGenerator::global()->bounded(2) == 0;
@@ -243,8 +421,122 @@ void DinoRunGame::generateTree()
         tree.height = 60 + QRandomGenerator::global()->bounded(20);
     }
 
-    tree.x = GAME_WIDTH + QRandomGenerator::global()->bounded(0, 100);
-    trees.append(tree);
+    tree.x = x;
+    return tree;
+}
+
+QImage DinoRunGame::renderLayerTile(LayerId id, qreal scale) const
+{
+    // Tiles are rendered at the internal resolution so they can be blitted 1:1.
+    // QImage rather than QPixmap because this runs on the asset thread.
+    const ParallaxLayer &layer = layers[id];
+    QImage tile(qRound(GAME_WIDTH * scale), qRound(layer.height * scale),
+                QImage::Format_ARGB32_Premultiplied);
+    tile.fill(Qt::transparent);
+
+    QPainter painter(&tile);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.scale(scale, scale);
+    painter.translate(0, -layer.y);
+    paintLayer(painter, id);
+
+    return tile;
+}
+
+void DinoRunGame::paintLayer(QPainter &painter, LayerId id) const
+{
+    // Shapes crossing the right edge are drawn again one strip to the left
+    // (and vice versa) so the strip wraps without a seam
+    for (int dx = -GAME_WIDTH; dx <= GAME_WIDTH; dx += GAME_WIDTH) {
+        painter.save();
+        painter.translate(dx, 0);
+
+        switch (id) {
+        case FAR_MOUNTAINS:
+            for (int i = 0; i < MOUNTAIN_COUNT; ++i) {
+                drawMountain(painter, mountains[i]);
+            }
+            break;
+        case NEAR_HILLS:
+            for (int i = 0; i < HILL_COUNT; ++i) {
+                drawHill(painter, hills[i]);
+            }
+            break;
+        case TREE_LINE:
+            for (int i = 0; i < TREE_LINE_COUNT; ++i) {
+                drawTree(painter, treeLine[i]);
+            }
+            break;
+        case GROUND_TEXTURE:
+            drawGround(painter);
+            drawPebbles(painter);
+            break;
+        default:
+            break;
+        }
+
+        painter.restore();
+    }
+}
+
+void DinoRunGame::prepareAssets()
+{
+    // A finished job re-checks the scale, so a request while busy is not lost
+    if (assetThread) {
+        return;
+    }
+
+    const qreal scale = renderScale;
+    const bool needHighScore = !highScoreLoaded;
+
+    // Only reads the layer layout, which is fixed after initializeMountains()
+    assetThread = QThread::create([this, scale, needHighScore]() {
+        for (int i = 0; i < LAYER_COUNT; ++i) {
+            preparedTiles[i] = renderLayerTile(static_cast<LayerId>(i), scale);
+        }
+        preparedScale = scale;
+
+        if (needHighScore) {
+            preparedHighScore = readHighScore();
+        }
+    });
+    assetThread->setParent(this);
+    connect(assetThread, &QThread::finished, this, &DinoRunGame::assetsReady);
+    connect(assetThread, &QThread::finished, assetThread, &QObject::deleteLater);
+    assetThread->start(QThread::LowPriority);
+}
+
+void DinoRunGame::assetsReady()
+{
+    for (int i = 0; i < LAYER_COUNT; ++i) {
+        layers[i].tile = QPixmap::fromImage(preparedTiles[i]);
+        preparedTiles[i] = QImage();
+    }
+    tileScale = preparedScale;
+
+    if (!highScoreLoaded) {
+        highScoreLoaded = true;
+
+        // A run may already have ended before the stored score was known,
+        // in which case it only counts as a new high score if it beats it
+        if (highScore > preparedHighScore) {
+            saveHighScore();
+        } else {
+            highScore = preparedHighScore;
+            isNewHighScore = false;
+        }
+    }
+
+    if (assetsReadyMs < 0) {
+        assetsReadyMs = startupTimer.elapsed();
+    }
+
+    assetThread = nullptr;
+    if (!qFuzzyCompare(tileScale, renderScale)) {
+        prepareAssets();
+    }
+
+    update();
 }
 
 // Drawing Methods
@@ -252,26 +544,73 @@ void DinoRunGame::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
 
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+
+    if (autoRenderScale) {
+        renderScale = qMin(renderScale, maxRenderScale());
+    }
+
+    // Reallocate the back buffer and re-render the strips when the scale changes
+    const QSize bufferSize(qRound(GAME_WIDTH * renderScale), qRound(VIEW_HEIGHT * renderScale));
+    if (frameBuffer.size() != bufferSize) {
+        frameBuffer = QImage(bufferSize, QImage::Format_ARGB32_Premultiplied);
+    }
+    if (!qFuzzyCompare(tileScale, renderScale)) {
+        prepareAssets();
+    }
+
+    {
+        QPainter bufferPainter(&frameBuffer);
+        bufferPainter.setRenderHint(QPainter::Antialiasing);
+        bufferPainter.scale(renderScale, renderScale);
+        renderFrame(bufferPainter);
+    }
+
+    // Scale the back buffer to the window, letterboxed to keep the aspect ratio
     QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), Qt::black);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(viewportRect(), frameBuffer);
+
+    if (firstFrameMs < 0) {
+        firstFrameMs = startupTimer.elapsed();
+    }
+
+    // Jumps simulated since the last frame are now on screen
+    if (!appliedInputTimes.isEmpty()) {
+        const qint64 presentedNs = gameTimer.nsecsElapsed();
+        for (qint64 inputNs : appliedInputTimes) {
+            inputLatenciesNs.append(presentedNs - inputNs);
+        }
+        appliedInputTimes.clear();
+    }
+
+    const double frameMs = frameTimer.nsecsElapsed() / 1.0e6;
+    averageFrameMs = averageFrameMs * 0.9 + frameMs * 0.1;
+
+    if (autoRenderScale) {
+        adjustRenderScale();
+    }
+}
+
+void DinoRunGame::renderFrame(QPainter &painter)
+{
+    painter.fillRect(0, 0, GAME_WIDTH, VIEW_HEIGHT, palette().window());
 
     // Draw all game elements in correct order
     drawBackground(painter);
     drawSun(painter);
 
-    for (int i = 0; i < MOUNTAIN_COUNT; ++i) {
-        drawMountain(painter, mountains[i]);
-    }
+    drawLayer(painter, FAR_MOUNTAINS);
+    drawLayer(painter, NEAR_HILLS);
 
     for (const Cloud &cloud : clouds) {
         drawCloud(painter, cloud);
     }
 
-    for (const Tree &tree : trees) {
-        drawTree(painter, tree);
-    }
-
-    drawGround(painter);
+    drawLayer(painter, TREE_LINE);
+    drawLayer(painter, GROUND_TEXTURE);
 
     for (const Cactus &cactus : cacti) {
         drawCactus(painter, cactus);
@@ -287,19 +626,85 @@ void DinoRunGame::paintEvent(QPaintEvent *event)
     }
 }
 
+QRect DinoRunGame::viewportRect() const
+{
+    QSize viewSize = QSize(GAME_WIDTH, VIEW_HEIGHT).scaled(size(), Qt::KeepAspectRatio);
+    return QRect(QPoint((width() - viewSize.width()) / 2, (height() - viewSize.height()) / 2),
+                 viewSize);
+}
+
+qreal DinoRunGame::maxRenderScale() const
+{
+    // Rendering beyond the physical pixels of the viewport only costs fill rate
+    qreal outputScale = viewportRect().width() * devicePixelRatioF() / GAME_WIDTH;
+    return qBound(MIN_RENDER_SCALE, std::ceil(outputScale / RENDER_SCALE_STEP) * RENDER_SCALE_STEP,
+                  MAX_RENDER_SCALE);
+}
+
+void DinoRunGame::adjustRenderScale()
+{
+    qreal newScale = renderScale;
+    if (averageFrameMs > FRAME_BUDGET_MS) {
+        newScale -= RENDER_SCALE_STEP;
+    } else if (averageFrameMs < FRAME_BUDGET_MS * 0.5) {
+        newScale += RENDER_SCALE_STEP;
+    }
+    newScale = qBound(MIN_RENDER_SCALE, newScale, maxRenderScale());
+
+    if (!qFuzzyCompare(newScale, renderScale)) {
+        renderScale = newScale;
+
+        // Start the average inside the dead band so one slow frame after the
+        // rebuild does not immediately swing the scale back
+        averageFrameMs = FRAME_BUDGET_MS * 0.75;
+    }
+}
+
 void DinoRunGame::drawBackground(QPainter &painter)
 {
     QLinearGradient skyGradient(0, 0, 0, GAME_HEIGHT);
     skyGradient.setColorAt(0, QColor(135, 206, 235));
     skyGradient.setColorAt(1, QColor(100, 180, 220));
-    painter.fillRect(0, 0, width(), GAME_HEIGHT, skyGradient);
+    painter.fillRect(0, 0, GAME_WIDTH, GAME_HEIGHT, skyGradient);
 }
 
 void DinoRunGame::drawSun(QPainter &painter)
 {
     painter.setBrush(QColor(255, 255, 180, 200));
     painter.setPen(Qt::NoPen);
-    painter.drawEllipse(width() - 120, 40, 45, 45);
+    painter.drawEllipse(GAME_WIDTH - 120, 40, 45, 45);
+}
+
+void DinoRunGame::drawLayer(QPainter &painter, LayerId id)
+{
+    const ParallaxLayer &layer = layers[id];
+
+    // Until tiles matching the painter's scale arrive, draw the vector shapes,
+    // clipped to the strip the tile would cover
+    if (layer.tile.isNull() || !qFuzzyCompare(tileScale, painter.transform().m11())) {
+        painter.save();
+        painter.setClipRect(0, layer.y, GAME_WIDTH, layer.height);
+        painter.translate(-layer.offset, 0);
+        paintLayer(painter, id);
+        painter.restore();
+        return;
+    }
+
+    // Blit in device pixels so the tile is copied 1:1 instead of resampled
+    const QTransform transform = painter.transform();
+    const QPointF origin = transform.map(QPointF(0, layer.y));
+    const int right = qRound(origin.x() + GAME_WIDTH * transform.m11());
+
+    painter.save();
+    painter.resetTransform();
+
+    // Two blits cover the screen: the tail of the strip, then its head
+    for (int x = qRound(origin.x() - layer.offset * transform.m11()); x < right;
+         x += layer.tile.width()) {
+        painter.drawPixmap(x, qRound(origin.y()), layer.tile);
+    }
+
+    painter.restore();
 }
 
 void DinoRunGame::drawMountain(QPainter &painter, const Mountain &mountain)
@@ -331,6 +736,25 @@ void DinoRunGame::drawMountain(QPainter &painter, const Mountain &mountain)
     painter.drawPolygon(mountainShape);
 }
 
+void DinoRunGame::drawHill(QPainter &painter, const Mountain &hill)
+{
+    painter.setPen(Qt::NoPen);
+
+    int groundY = GAME_HEIGHT - GROUND_HEIGHT;
+    QLinearGradient hillGrad(0, groundY - hill.height, 0, groundY);
+    if (hill.isBig) {
+        hillGrad.setColorAt(0, QColor(128, 168, 120));
+        hillGrad.setColorAt(1, QColor(96, 136, 92));
+    } else {
+        hillGrad.setColorAt(0, QColor(146, 184, 132));
+        hillGrad.setColorAt(1, QColor(112, 152, 104));
+    }
+    painter.setBrush(hillGrad);
+
+    // Only the upper half of the ellipse sits above the ground line
+    painter.drawEllipse(hill.x, groundY - hill.height, hill.width, hill.height * 2);
+}
+
 void DinoRunGame::drawCloud(QPainter &painter, const Cloud &cloud)
 {
     painter.setPen(Qt::NoPen);
@@ -384,12 +808,27 @@ void DinoRunGame::drawGround(QPainter &painter)
     groundGrad.setColorAt(0, QColor(210, 180, 140));
     groundGrad.setColorAt(1, QColor(180, 150, 110));
     painter.fillRect(0, GAME_HEIGHT - GROUND_HEIGHT,
-                     width(), GROUND_HEIGHT, groundGrad);
+                     GAME_WIDTH, GROUND_HEIGHT, groundGrad);
 
     // Ground line
     painter.setPen(QPen(QColor(160, 130, 90), 3));
     painter.drawLine(0, GAME_HEIGHT - GROUND_HEIGHT,
-                     width(), GAME_HEIGHT - GROUND_HEIGHT);
+                     GAME_WIDTH, GAME_HEIGHT - GROUND_HEIGHT);
+}
+
+void DinoRunGame::drawPebbles(QPainter &painter)
+{
+    // Pebbles and dirt specks give the scrolling ground visible motion.
+    // Fixed seed so the texture is identical at every render scale.
+    QRandomGenerator pebbles(42);
+    painter.setPen(Qt::NoPen);
+    for (int i = 0; i < 40; ++i) {
+        int size = 2 + pebbles.bounded(4);
+        int x = pebbles.bounded(GAME_WIDTH - size);
+        int y = GAME_HEIGHT - GROUND_HEIGHT + 6 + pebbles.bounded(GROUND_HEIGHT - 10);
+        painter.setBrush(i % 3 == 0 ? QColor(160, 130, 90) : QColor(195, 165, 125));
+        painter.drawEllipse(x, y, size * 2, size);
+    }
 }
 
 void DinoRunGame::drawDino(QPainter &painter)
@@ -552,14 +991,14 @@ void DinoRunGame::drawUI(QPainter &painter)
 void DinoRunGame::drawStartScreen(QPainter &painter)
 {
     // Semi-transparent overlay
-    painter.fillRect(rect(), QColor(0, 0, 0, 180));
+    painter.fillRect(0, 0, GAME_WIDTH, VIEW_HEIGHT, QColor(0, 0, 0, 180));
 
     QFont titleFont("Arial", 48, QFont::Bold);
     QFont subtitleFont("Arial", 24);
     QFont instructionFont("Arial", 18);
 
     // Calculate center positions
-    int centerX = width() / 2;
+    int centerX = GAME_WIDTH / 2;
 
     // Title
     drawTextWithShadow(painter, centerX - 200, 150, "DINO RUN",
@@ -583,14 +1022,14 @@ void DinoRunGame::drawStartScreen(QPainter &painter)
 void DinoRunGame::drawGameOverScreen(QPainter &painter)
 {
     // Semi-transparent overlay
-    painter.fillRect(rect(), QColor(0, 0, 0, 200));
+    painter.fillRect(0, 0, GAME_WIDTH, VIEW_HEIGHT, QColor(0, 0, 0, 200));
 
     QFont gameOverFont("Arial", 64, QFont::Bold);
     QFont scoreFont("Arial", 36, QFont::Bold);
     QFont instructionFont("Arial", 24);
 
     // Calculate center positions
-    int centerX = width() / 2;
+    int centerX = GAME_WIDTH / 2;
 
     // Game Over text
     drawTextWithShadow(painter, centerX - 250, 150, "GAME OVER",
@@ -621,16 +1060,121 @@ void DinoRunGame::drawGameOverScreen(QPainter &painter)
 // Game Loop
 void DinoRunGame::gameLoop()
 {
-    if (gameState == PLAYING) {
-        updateDino();
-        updateCacti();
-        updateClouds();
-        updateTrees();
-        checkCollisions();
+    if (gameState != PLAYING) {
+        return;
+    }
+
+    // Nobody is watching an unthrottled capture: one tick per call and no
+    // window repaint
+    if (captureFast) {
+        simulateTick();
+        return;
+    }
+
+    // Run every fixed step that has elapsed on the wall clock, allowing a
+    // little slack so timer jitter does not alternate between zero and two
+    // ticks per call. After a long stall the simulation skips ahead instead
+    // of fast-forwarding.
+    const qint64 now = gameTimer.nsecsElapsed() + TICK_SLACK_NS;
+    if (now - simClockNs > MAX_CATCH_UP_TICKS * TICK_NS) {
+        simClockNs = now - TICK_NS;
+    }
+
+    bool ticked = false;
+    while (gameState == PLAYING && simClockNs + TICK_NS <= now) {
+        simClockNs += TICK_NS;
+        simulateTick();
+        ticked = true;
+    }
+
+    if (ticked) {
         update();
     }
 }
 
+void DinoRunGame::startSimulationClock()
+{
+    inputQueue.clear();
+    simClockNs = gameTimer.nsecsElapsed();
+}
+
+void DinoRunGame::applyInputs()
+{
+    // Events up to the end of the tick being simulated; later ones wait.
+    // A press that arrived while the loop was running ahead of the wall
+    // clock falls inside an earlier tick, and the first step makes up for it.
+    const InputEvent *event;
+    while ((event = inputQueue.front()) && event->timeNs <= simClockNs) {
+        if (event->key == Qt::Key_Space && dino.state == RUNNING) {
+            dino.state = JUMPING;
+            dino.velocity = JUMP_VELOCITY;
+            dino.stepFraction = qBound(0.0f, static_cast<float>(simClockNs - event->timeNs) / TICK_NS,
+                                       DinoPhysics::MAX_FIRST_STEP);
+            recordTrace(TRACE_JUMP);
+
+            if (benchmarkEnabled) {
+                appliedInputTimes.append(event->timeNs);
+            }
+        }
+        inputQueue.pop();
+    }
+}
+
+void DinoRunGame::simulateTick()
+{
+    simTime += TICK_MS;
+    applyInputs();
+    updateDino();
+    updateCacti();
+    updateClouds();
+    updateLayers();
+    checkCollisions();
+    ++tickCount;
+    recordTrace(gameState == GAME_OVER ? TRACE_DEATH : TRACE_TICK);
+
+    if (frameCapture) {
+        captureFrame();
+
+        // A headless capture covers a single run
+        if (frameCapture && captureFast && gameState == GAME_OVER) {
+            stopCapture();
+        }
+    }
+}
+
+void DinoRunGame::recordTrace(TraceEvent event)
+{
+    if (!traceWriter) {
+        return;
+    }
+
+    TraceRecord record = {};
+    record.timeMs = simTime;
+    record.tick = tickCount;
+    record.dinoY = dino.baseY - dino.y;
+    record.dinoVelocity = dino.velocity;
+    record.gameSpeed = gameSpeed;
+    record.score = score;
+    record.event = event;
+    record.cactusGap = -1;
+    record.cactusType = 0xff;
+
+    // Nearest cactus not yet fully behind the dino
+    for (const Cactus &cactus : cacti) {
+        if (cactus.x + cactus.width < dino.x) {
+            continue;
+        }
+        const int gap = qMax(0, cactus.x - (dino.x + dino.width));
+        if (record.cactusGap < 0 || gap < record.cactusGap) {
+            record.cactusGap = gap;
+            record.cactusType = static_cast<quint8>(cactus.type);
+            record.cactusHeight = static_cast<quint16>(cactus.height);
+        }
+    }
+
+    traceWriter->append(record);
+}
+
 // Key Events
 void DinoRunGame::keyPressEvent(QKeyEvent *event)
 {
@@ -638,10 +1182,12 @@ void DinoRunGame::keyPressEvent(QKeyEvent *event)
     case Qt::Key_Space:
         if (gameState == START) {
             gameState = PLAYING;
+            startSimulationClock();
             updateTimer->start();
-        } else if (gameState == PLAYING && dino.state == RUNNING) {
-            dino.state = JUMPING;
-            dino.velocity = JUMP_VELOCITY;
+            recordTrace(TRACE_START);
+        } else if (gameState == PLAYING) {
+            // Timestamped now, applied at this exact time inside the next tick
+            inputQueue.push(InputEvent{gameTimer.nsecsElapsed(), Qt::Key_Space});
         }
         break;
 
@@ -650,11 +1196,8 @@ void DinoRunGame::keyPressEvent(QKeyEvent *event)
             gameState = PLAYING;
             initializeGame();
             initializeDino();
-
-            // Generate initial trees
-            for (int i = 0; i < 3; ++i) {
-                generateTree();
-            }
+            startSimulationClock();
+            recordTrace(TRACE_START);
 
             if (!updateTimer->isActive()) {
                 updateTimer->start();
@@ -673,18 +1216,25 @@ void DinoRunGame::keyPressEvent(QKeyEvent *event)
 }
 
 // High Score Management
-void DinoRunGame::loadHighScore()
+int DinoRunGame::readHighScore()
 {
+    int storedScore = 0;
     QFile file("dino_highscore.txt");
     if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream in(&file);
-        in >> highScore;
+        in >> storedScore;
         file.close();
     }
+    return storedScore;
 }
 
 void DinoRunGame::saveHighScore()
 {
+    // Wait until the stored score is known so a lower one never replaces it
+    if (!highScoreLoaded) {
+        return;
+    }
+
     QFile file("dino_highscore.txt");
     if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
         QTextStream out(&file);
@@ -4,10 +4,19 @@
 #include <QWidget>
 #include <QTimer>
 #include <QPainter>
+#include <QPixmap>
+#include <QImage>
 #include <QKeyEvent>
 #include <QRandomGenerator>
 #include <QElapsedTimer>
+#include <QThread>
 #include <QVector>
+#include <QFile>
+#include <QTextStream>
+#include "DinoPhysics.h"
+#include "DinoTrace.h"
+#include "FrameCapture.h"
+#include "InputQueue.h"
 
 class DinoRunGame : public QWidget {
     Q_OBJECT
@@ -16,6 +25,25 @@ public:
     explicit DinoRunGame(QWidget *parent = nullptr);
     ~DinoRunGame();
 
+    // Fixes the internal render resolution as a multiple of the logical
+    // GAME_WIDTH x VIEW_HEIGHT scene. By default the scale is chosen
+    // automatically from the window size and the measured frame time.
+    void setRenderScale(qreal scale);
+
+    // Streams a per-tick gameplay trace to fileName (see DinoTrace.h)
+    bool startTrace(const QString &fileName);
+
+    // Renders one frame per simulation tick into numbered images in
+    // directory. A fast capture starts the run immediately, runs it as fast
+    // as the encoders keep up and closes the game when it ends or after
+    // frameLimit frames (0 for no limit).
+    bool startCapture(const QString &directory, FrameCapture::Format format,
+                      int frameLimit, bool fast);
+
+    // Prints startup and frame timings, and the p50/p99 latency from a jump
+    // key press to the end of the paint that shows it, when the game is closed
+    void setBenchmark(bool enabled);
+
 protected:
     void paintEvent(QPaintEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
@@ -25,10 +53,31 @@ private:
     static const int GAME_WIDTH = 800;
     static const int GAME_HEIGHT = 400;
     static const int GROUND_HEIGHT = 50;
+    static const int VIEW_HEIGHT = GAME_HEIGHT + GROUND_HEIGHT;
     static const int MOUNTAIN_COUNT = 4;
+    static const int HILL_COUNT = 6;
+    static const int TREE_LINE_COUNT = 9;
+    static const int TICK_MS = DinoPhysics::TICK_MS;
+    static const int CAPTURE_POOL_SIZE = 8;
+    static const int MAX_CATCH_UP_TICKS = 5;
+    static constexpr qint64 TICK_NS = TICK_MS * 1000000LL;
+    static constexpr qint64 TICK_SLACK_NS =
+            static_cast<qint64>((DinoPhysics::MAX_FIRST_STEP - 1.0f) * TICK_NS);
+    static constexpr float INITIAL_GAME_SPEED = DinoPhysics::INITIAL_GAME_SPEED;
+    static constexpr float MAX_GAME_SPEED = DinoPhysics::MAX_GAME_SPEED;
+    static constexpr float SPEED_INCREMENT = DinoPhysics::SPEED_INCREMENT;
+    static constexpr float GRAVITY = DinoPhysics::GRAVITY;
+    static constexpr float JUMP_VELOCITY = DinoPhysics::JUMP_VELOCITY;
+
+    // Render scale limits and the paint time budget for automatic scaling
+    static constexpr qreal MIN_RENDER_SCALE = 0.5;
+    static constexpr qreal MAX_RENDER_SCALE = 4.0;
+    static constexpr qreal RENDER_SCALE_STEP = 0.25;
+    static constexpr double FRAME_BUDGET_MS = 8.0;
 
     // Game states
     enum GameState { START, PLAYING, GAME_OVER };
+    enum DinoState { RUNNING, JUMPING, DEAD };
     GameState gameState;
 
     // Game objects
@@ -36,14 +85,31 @@ private:
         int x, y, baseY;
         int width, height;
         float velocity;
-        bool isJumping;
+        float stepFraction; // share of a tick to integrate next, 0 to MAX_FIRST_STEP after a jump
+        DinoState state;
         int frame;
+        float animationTimer;
+
+        QRect hitbox() const
+        {
+            using namespace DinoPhysics;
+            return QRect(x + DINO_HITBOX_INSET_X, y + DINO_HITBOX_INSET_TOP,
+                         width - 2 * DINO_HITBOX_INSET_X,
+                         height - DINO_HITBOX_INSET_TOP - DINO_HITBOX_INSET_BOTTOM);
+        }
     } dino;
 
     struct Cactus {
         int x, y;
         int width, height;
-        int type; // 0: small, 1: large, 2: cluster
+        int type; // 0: small, 1: medium, 2: large, 3: double
+
+        QRect hitbox() const
+        {
+            using namespace DinoPhysics;
+            return QRect(x + CACTUS_HITBOX_INSET, y + CACTUS_HITBOX_INSET,
+                         width - 2 * CACTUS_HITBOX_INSET, height - CACTUS_HITBOX_INSET);
+        }
     };
 
     struct Cloud {
@@ -64,45 +130,130 @@ private:
         bool isBig;
     };
 
+    // Parallax layers, back to front. Each one is rendered once into a
+    // GAME_WIDTH wide strip that wraps seamlessly and is blitted twice per frame.
+    enum LayerId { FAR_MOUNTAINS, NEAR_HILLS, TREE_LINE, GROUND_TEXTURE, LAYER_COUNT };
+
+    struct ParallaxLayer {
+        QPixmap tile;
+        int y;        // top of the strip in game coordinates
+        int height;   // strip height in game coordinates
+        float speed;  // scroll speed as a fraction of gameSpeed
+        float offset; // current scroll position inside the tile
+    };
+
     // Game variables
     QVector<Cactus> cacti;
     QVector<Cloud> clouds;
-    QVector<Tree> trees;  // Changed from array to QVector
     Mountain mountains[MOUNTAIN_COUNT];
-    QTimer *updateTimer;
-    QElapsedTimer gameTimer;
+    Mountain hills[HILL_COUNT];
+    Tree treeLine[TREE_LINE_COUNT];
+    ParallaxLayer layers[LAYER_COUNT];
     float gameSpeed;
     int score;
     int highScore;
+    bool isNewHighScore;
     qint64 lastCactusTime;
     qint64 lastCloudTime;
-    qint64 lastTreeTime;  // Added missing declaration
+    QTimer *updateTimer;
+    QElapsedTimer gameTimer;
+
+    // Internal resolution
+    qreal renderScale;
+    bool autoRenderScale;
+    double averageFrameMs;
+    QImage frameBuffer;
+
+    // Telemetry, only allocated when tracing is enabled
+    TraceWriter *traceWriter;
+    quint32 tickCount;
+
+    // Background asset preparation. The worker fills the prepared* members
+    // and assetsReady() swaps them in on the GUI thread.
+    QThread *assetThread;
+    QImage preparedTiles[LAYER_COUNT];
+    qreal preparedScale;
+    int preparedHighScore;
+    qreal tileScale;
+    bool highScoreLoaded;
+
+    // Startup metrics, -1 until reached
+    QElapsedTimer startupTimer;
+    qint64 firstFrameMs;
+    qint64 assetsReadyMs;
+    bool benchmarkEnabled;
+
+    // Simulation clock, advanced by TICK_MS per game loop tick
+    qint64 simTime;
+
+    // Frame capture, only allocated while capturing
+    FrameCapture *frameCapture;
+    int captureFrameLimit;
+    bool captureFast;
+
+    // Fixed-step input handling. Key presses are queued with their arrival
+    // time and applied at that time within the tick that covers it.
+    qint64 simClockNs; // gameTimer time the simulation has been advanced to
+    InputQueue<64> inputQueue;
+    QVector<qint64> appliedInputTimes;
+    QVector<qint64> inputLatenciesNs;
 
     // Game methods
     void initializeDino();
     void initializeMountains();
+    void initializeLayers();
     void initializeGame();
     void gameLoop();
+    void startSimulationClock();
+    void applyInputs();
+    void simulateTick();
 
     void updateDino();
     void updateCacti();
     void updateClouds();
-    void updateTrees();
+    void updateLayers();
     void checkCollisions();
+    void recordTrace(TraceEvent event);
+    void captureFrame();
+    void stopCapture();
 
-    void generateCactus();
+    bool generateCactus();
+    bool isFairSpawn(int type, int step) const;
     void generateCloud();
-    void generateTree();  // Added missing declaration
+    Tree generateTree(int x);
 
+    void prepareAssets();
+    void assetsReady();
+    QImage renderLayerTile(LayerId id, qreal scale) const;
+    void paintLayer(QPainter &painter, LayerId id) const;
+
+    void renderFrame(QPainter &painter);
+    QRect viewportRect() const;
+    qreal maxRenderScale() const;
+    void adjustRenderScale();
+    void printBenchmark() const;
+
+    void drawBackground(QPainter &painter);
+    void drawSun(QPainter &painter);
+    void drawLayer(QPainter &painter, LayerId id);
     void drawDino(QPainter &painter);
     void drawCactus(QPainter &painter, const Cactus &cactus);
     void drawCloud(QPainter &painter, const Cloud &cloud);
-    void drawMountain(QPainter &painter, const Mountain &mountain);
-    void drawTree(QPainter &painter, const Tree &tree);
-    void drawGround(QPainter &painter);
+    static void drawMountain(QPainter &painter, const Mountain &mountain);
+    static void drawHill(QPainter &painter, const Mountain &hill);
+    static void drawTree(QPainter &painter, const Tree &tree);
+    static void drawGround(QPainter &painter);
+    static void drawPebbles(QPainter &painter);
     void drawUI(QPainter &painter);
     void drawStartScreen(QPainter &painter);
     void drawGameOverScreen(QPainter &painter);
+    void drawTextWithShadow(QPainter &painter, int x, int y, const QString &text,
+                            const QFont &font, const QColor &textColor,
+                            const QColor &shadowColor, int shadowOffset = 2);
+
+    // High score persistence
+    static int readHighScore();
+    void saveHighScore();
 };
 
 #endif // DINORUNGAME_H
@@ -0,0 +1,140 @@
+#include "DinoTrace.h"
+#include <cstring>
+
+TraceWriter::TraceWriter(QObject *parent)
+    : QThread(parent)
+    , stopping(false)
+    , dropped(0)
+    , unmarkedDrops(0)
+    , failed(0)
+{
+    pending.reserve(FLUSH_RECORDS);
+    writing.reserve(FLUSH_RECORDS);
+}
+
+TraceWriter::~TraceWriter()
+{
+    close();
+}
+
+bool TraceWriter::open(const QString &fileName)
+{
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    TraceHeader header;
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.recordSize = sizeof(TraceRecord);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    stopping = false;
+    dropped = 0;
+    unmarkedDrops = 0;
+    failed = 0;
+    start(QThread::LowPriority);
+    return true;
+}
+
+void TraceWriter::close()
+{
+    if (isRunning()) {
+        {
+            QMutexLocker locker(&mutex);
+
+            // Drops at the very end have no later record to carry the marker
+            if (unmarkedDrops > 0) {
+                TraceRecord gap = pending.isEmpty() ? TraceRecord{} : pending.last();
+                gap.event = TRACE_GAP;
+                gap.lostRecords = unmarkedDrops;
+                pending.append(gap);
+                unmarkedDrops = 0;
+            }
+
+            stopping = true;
+            dataReady.wakeOne();
+        }
+        wait();
+    }
+
+    if (file.isOpen()) {
+        if (dropped > 0 || failed > 0) {
+            qWarning("Trace %s is incomplete: %llu records dropped, %llu failed to write",
+                     qPrintable(file.fileName()), dropped, failed);
+        }
+        file.close();
+    }
+}
+
+void TraceWriter::append(const TraceRecord &record)
+{
+    QMutexLocker locker(&mutex);
+
+    // After a drop the next record needs room for the gap marker as well
+    if (pending.size() + (unmarkedDrops > 0 ? 2 : 1) > MAX_PENDING_RECORDS) {
+        ++dropped;
+        ++unmarkedDrops;
+        return;
+    }
+
+    if (unmarkedDrops > 0) {
+        TraceRecord gap = record;
+        gap.event = TRACE_GAP;
+        gap.lostRecords = unmarkedDrops;
+        pending.append(gap);
+        unmarkedDrops = 0;
+    }
+
+    pending.append(record);
+    if (pending.size() == FLUSH_RECORDS) {
+        dataReady.wakeOne();
+    }
+}
+
+quint64 TraceWriter::droppedRecords() const
+{
+    QMutexLocker locker(&mutex);
+    return dropped;
+}
+
+quint64 TraceWriter::failedRecords() const
+{
+    QMutexLocker locker(&mutex);
+    return failed;
+}
+
+void TraceWriter::run()
+{
+    for (;;) {
+        bool finished;
+        {
+            QMutexLocker locker(&mutex);
+            if (!stopping && pending.size() < FLUSH_RECORDS) {
+                dataReady.wait(&mutex, FLUSH_INTERVAL_MS);
+            }
+
+            // Swap so the game thread keeps appending while we write
+            pending.swap(writing);
+            finished = stopping;
+        }
+
+        if (!writing.isEmpty()) {
+            const qint64 bytes = writing.size() * static_cast<qint64>(sizeof(TraceRecord));
+            if (file.write(reinterpret_cast<const char *>(writing.constData()), bytes) != bytes
+                || !file.flush()) {
+                QMutexLocker locker(&mutex);
+                failed += writing.size();
+            }
+            writing.clear();
+        }
+
+        // Everything appended before stop was requested has been swapped out
+        if (finished) {
+            break;
+        }
+    }
+}
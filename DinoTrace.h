@@ -0,0 +1,82 @@
+#ifndef DINOTRACE_H
+#define DINOTRACE_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QVector>
+
+// On-disk layout of a gameplay trace: one TraceHeader followed by
+// fixed-size TraceRecords in native (little-endian) byte order, so the
+// file can be memory-mapped and read as an array.
+static const char TRACE_MAGIC[8] = { 'D', 'I', 'N', 'O', 'T', 'R', 'C', '1' };
+static const quint32 TRACE_VERSION = 1;
+
+// TRACE_GAP marks records the writer had to drop. It is written just before
+// the first record that fits again, which follows it as usual, and carries a
+// copy of that record's state. Readers should count only lostRecords from it.
+enum TraceEvent : quint8 { TRACE_TICK, TRACE_JUMP, TRACE_DEATH, TRACE_START, TRACE_GAP };
+
+struct TraceHeader {
+    char magic[8];
+    quint32 version;
+    quint32 recordSize;
+};
+
+struct TraceRecord {
+    qint64 timeMs;        // game clock at the time of the record
+    quint32 tick;         // simulation tick since the run started
+    qint32 dinoY;         // height above the ground in pixels
+    float dinoVelocity;
+    float gameSpeed;
+    qint32 cactusGap;     // pixels from the dino to the nearest cactus ahead, -1 if none
+    qint32 score;
+    quint8 event;         // TraceEvent
+    quint8 cactusType;    // type of the nearest cactus, 0xff if none
+    quint16 cactusHeight;
+    quint32 lostRecords;  // TRACE_GAP: records dropped since the previous record
+};
+
+static_assert(sizeof(TraceHeader) == 16, "TraceHeader layout is part of the file format");
+static_assert(sizeof(TraceRecord) == 40, "TraceRecord layout is part of the file format");
+
+// Appends trace records to a file from a background thread. append() only
+// copies the record into a buffer under a short lock, so it never waits on
+// disk I/O; the writer thread swaps the buffer out and flushes it in bulk.
+// Records dropped under backpressure are marked in the file, and together
+// with records that failed to write are reported when the trace is closed.
+class TraceWriter : public QThread {
+public:
+    explicit TraceWriter(QObject *parent = nullptr);
+    ~TraceWriter() override;
+
+    bool open(const QString &fileName);
+    void close();
+
+    void append(const TraceRecord &record);
+    quint64 droppedRecords() const;
+    quint64 failedRecords() const;
+
+protected:
+    void run() override;
+
+private:
+    // Flush once this many records are pending, or after the interval
+    static const int FLUSH_RECORDS = 4096;
+    static const int FLUSH_INTERVAL_MS = 250;
+    // Records beyond this are dropped rather than growing without bound
+    static const int MAX_PENDING_RECORDS = 1 << 20;
+
+    QFile file;
+    mutable QMutex mutex;
+    QWaitCondition dataReady;
+    QVector<TraceRecord> pending;
+    QVector<TraceRecord> writing;
+    bool stopping;
+    quint64 dropped;
+    quint32 unmarkedDrops; // dropped since the last TRACE_GAP record
+    quint64 failed;
+};
+
+#endif // DINOTRACE_H
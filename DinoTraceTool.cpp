@@ -0,0 +1,215 @@
+// Summarises gameplay traces written by TraceWriter. The trace is
+// memory-mapped and scanned in parallel chunks, one per hardware thread.
+//
+// Usage: DinoTrace <trace-file>
+
+#include "DinoTrace.h"
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int CACTUS_TYPES = 4;
+const int GAP_BUCKET = 25;
+const int GAP_BUCKETS = 16;
+
+struct Summary {
+    quint64 ticks = 0;
+    quint64 jumps = 0;
+    quint64 runs = 0;
+    quint64 deaths = 0;
+    quint64 gaps = 0;
+    quint64 lostRecords = 0;
+    quint64 deathsByType[CACTUS_TYPES + 1] = {}; // last slot: no cactus recorded
+    qint64 deathScoreTotal = 0;
+    qint32 bestScore = 0;
+    double deathSpeedTotal = 0.0;
+
+    // Gap to the nearest cactus when the jump was pressed. Slot 0 counts
+    // jumps with no cactus ahead, the last slot everything past the range.
+    quint64 jumpGaps[GAP_BUCKETS + 2] = {};
+
+    void add(const TraceRecord &record)
+    {
+        switch (record.event) {
+        case TRACE_TICK:
+            ++ticks;
+            break;
+        case TRACE_JUMP:
+            ++jumps;
+            if (record.cactusGap < 0) {
+                ++jumpGaps[0];
+            } else {
+                ++jumpGaps[1 + std::min(record.cactusGap / GAP_BUCKET, GAP_BUCKETS)];
+            }
+            break;
+        case TRACE_DEATH:
+            ++deaths;
+            ++deathsByType[record.cactusType < CACTUS_TYPES ? record.cactusType : CACTUS_TYPES];
+            deathScoreTotal += record.score;
+            bestScore = std::max(bestScore, record.score);
+            deathSpeedTotal += record.gameSpeed;
+            break;
+        case TRACE_START:
+            ++runs;
+            break;
+        case TRACE_GAP:
+            ++gaps;
+            lostRecords += record.lostRecords;
+            break;
+        }
+    }
+
+    void merge(const Summary &other)
+    {
+        ticks += other.ticks;
+        jumps += other.jumps;
+        runs += other.runs;
+        deaths += other.deaths;
+        gaps += other.gaps;
+        lostRecords += other.lostRecords;
+        for (int i = 0; i <= CACTUS_TYPES; ++i) {
+            deathsByType[i] += other.deathsByType[i];
+        }
+        deathScoreTotal += other.deathScoreTotal;
+        bestScore = std::max(bestScore, other.bestScore);
+        deathSpeedTotal += other.deathSpeedTotal;
+        for (int i = 0; i < GAP_BUCKETS + 2; ++i) {
+            jumpGaps[i] += other.jumpGaps[i];
+        }
+    }
+};
+
+Summary scan(const TraceRecord *records, qint64 count)
+{
+    const int threadCount = std::max(1, QThread::idealThreadCount());
+    const qint64 chunk = (count + threadCount - 1) / threadCount;
+
+    std::vector<Summary> partials(threadCount);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        const qint64 begin = t * chunk;
+        const qint64 end = std::min(count, begin + chunk);
+        if (begin >= end) {
+            break;
+        }
+        workers.emplace_back([&partials, records, t, begin, end]() {
+            Summary &summary = partials[t];
+            for (qint64 i = begin; i < end; ++i) {
+                summary.add(records[i]);
+            }
+        });
+    }
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    Summary total;
+    for (const Summary &partial : partials) {
+        total.merge(partial);
+    }
+    return total;
+}
+
+void printHistogramRow(QTextStream &out, const QString &label, quint64 count, quint64 total)
+{
+    const int barWidth = total ? static_cast<int>(40 * count / total) : 0;
+    out << label.leftJustified(14) << QString::number(count).rightJustified(12)
+        << "  " << QString(barWidth, QChar('#')) << "\n";
+}
+
+void printSummary(QTextStream &out, const Summary &summary)
+{
+    static const char *const cactusNames[CACTUS_TYPES + 1] = {
+        "small", "medium", "large", "double", "unknown"
+    };
+
+    out << "ticks:     " << summary.ticks << "\n";
+    out << "jumps:     " << summary.jumps << "\n";
+    out << "runs:      " << summary.runs << "\n";
+    out << "deaths:    " << summary.deaths << "\n";
+
+    if (summary.deaths > 0) {
+        out << "avg score at death: "
+            << QString::number(double(summary.deathScoreTotal) / summary.deaths, 'f', 1) << "\n";
+        out << "avg speed at death: "
+            << QString::number(summary.deathSpeedTotal / summary.deaths, 'f', 2) << "\n";
+        out << "best score:         " << summary.bestScore << "\n";
+    }
+
+    out << "\nDeaths by cactus type\n";
+    for (int i = 0; i <= CACTUS_TYPES; ++i) {
+        printHistogramRow(out, cactusNames[i], summary.deathsByType[i], summary.deaths);
+    }
+
+    out << "\nGap to nearest cactus at jump (px)\n";
+    printHistogramRow(out, "none", summary.jumpGaps[0], summary.jumps);
+    for (int i = 0; i < GAP_BUCKETS; ++i) {
+        printHistogramRow(out, QString("%1-%2").arg(i * GAP_BUCKET).arg((i + 1) * GAP_BUCKET - 1),
+                          summary.jumpGaps[i + 1], summary.jumps);
+    }
+    printHistogramRow(out, QString(">=%1").arg(GAP_BUCKETS * GAP_BUCKET),
+                      summary.jumpGaps[GAP_BUCKETS + 1], summary.jumps);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList args = app.arguments();
+    if (args.size() != 2) {
+        err << "Usage: DinoTrace <trace-file>\n";
+        return 1;
+    }
+
+    QFile file(args.at(1));
+    if (!file.open(QIODevice::ReadOnly)) {
+        err << "Cannot open " << file.fileName() << ": " << file.errorString() << "\n";
+        return 1;
+    }
+
+    const qint64 size = file.size();
+    if (size < static_cast<qint64>(sizeof(TraceHeader))) {
+        err << file.fileName() << " is not a trace file\n";
+        return 1;
+    }
+
+    const uchar *data = file.map(0, size);
+    if (!data) {
+        err << "Cannot map " << file.fileName() << ": " << file.errorString() << "\n";
+        return 1;
+    }
+
+    TraceHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != TRACE_VERSION || header.recordSize != sizeof(TraceRecord)) {
+        err << file.fileName() << " is not a supported trace file\n";
+        return 1;
+    }
+
+    // A trailing partial record means the game was killed mid-flush; ignore it
+    const qint64 count = (size - static_cast<qint64>(sizeof(TraceHeader))) / sizeof(TraceRecord);
+    const auto *records = reinterpret_cast<const TraceRecord *>(data + sizeof(TraceHeader));
+
+    const Summary summary = scan(records, count);
+    if (summary.gaps > 0) {
+        err << "Warning: the game dropped " << summary.lostRecords << " records in "
+            << summary.gaps << " gaps while writing this trace; the counts below are incomplete\n";
+        err.flush();
+    }
+    printSummary(out, summary);
+
+    file.unmap(const_cast<uchar *>(data));
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "FrameCapture.h"
+#include <QDir>
+#include <QFile>
+
+FrameCapture::FrameCapture(const QSize &frameSize, int poolSize)
+    : format(PNG)
+    , nextFrameNumber(0)
+    , failedFrames(0)
+    , droppedFrames(0)
+    , stopping(false)
+{
+    // Allocated once up front; the vector is never resized afterwards so
+    // the buffers can be handed out by pointer
+    pool.reserve(poolSize);
+    for (int i = 0; i < poolSize; ++i) {
+        pool.emplace_back(frameSize, QImage::Format_ARGB32_Premultiplied);
+        freeSlots.append(i);
+    }
+}
+
+FrameCapture::~FrameCapture()
+{
+    finish();
+}
+
+bool FrameCapture::start(const QString &directory, Format format, int encoderCount)
+{
+    if (!QDir().mkpath(directory)) {
+        return false;
+    }
+
+    this->directory = directory;
+    this->format = format;
+    stopping = false;
+
+    for (int i = 0; i < qMax(1, encoderCount); ++i) {
+        QThread *encoder = QThread::create([this]() { encodeLoop(); });
+        encoder->start(QThread::LowPriority);
+        encoders.append(encoder);
+    }
+    return true;
+}
+
+void FrameCapture::finish()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        frameQueued.wakeAll();
+    }
+
+    // Encoders drain the queue before they exit
+    for (QThread *encoder : encoders) {
+        encoder->wait();
+        delete encoder;
+    }
+    encoders.clear();
+}
+
+QImage *FrameCapture::acquireFrame()
+{
+    QMutexLocker locker(&mutex);
+    while (freeSlots.isEmpty()) {
+        slotFreed.wait(&mutex);
+    }
+    return &pool[freeSlots.takeLast()];
+}
+
+QImage *FrameCapture::tryAcquireFrame()
+{
+    QMutexLocker locker(&mutex);
+    if (freeSlots.isEmpty()) {
+        ++droppedFrames;
+        return nullptr;
+    }
+    return &pool[freeSlots.takeLast()];
+}
+
+void FrameCapture::submitFrame(QImage *frame)
+{
+    const int slot = static_cast<int>(frame - pool.data());
+
+    QMutexLocker locker(&mutex);
+    queue.enqueue(QueuedFrame{nextFrameNumber++, slot});
+    frameQueued.wakeOne();
+}
+
+int FrameCapture::framesSubmitted() const
+{
+    QMutexLocker locker(&mutex);
+    return nextFrameNumber;
+}
+
+int FrameCapture::framesFailed() const
+{
+    QMutexLocker locker(&mutex);
+    return failedFrames;
+}
+
+int FrameCapture::framesDropped() const
+{
+    QMutexLocker locker(&mutex);
+    return droppedFrames;
+}
+
+void FrameCapture::encodeLoop()
+{
+    for (;;) {
+        QueuedFrame frame;
+        {
+            QMutexLocker locker(&mutex);
+            while (queue.isEmpty() && !stopping) {
+                frameQueued.wait(&mutex);
+            }
+            if (queue.isEmpty()) {
+                return;
+            }
+            frame = queue.dequeue();
+        }
+
+        // The slot is owned by this thread until it is put back on the free list
+        const bool written = writeFrame(pool[frame.slot], frame.number);
+
+        QMutexLocker locker(&mutex);
+        if (!written) {
+            ++failedFrames;
+        }
+        freeSlots.append(frame.slot);
+        slotFreed.wakeOne();
+    }
+}
+
+bool FrameCapture::writeFrame(const QImage &image, int number) const
+{
+    const QString baseName = QString("%1/frame_%2").arg(directory).arg(number, 6, 10, QChar('0'));
+
+    if (format == PNG) {
+        return image.save(baseName + ".png", "PNG");
+    }
+
+    // Raw frames are the premultiplied ARGB32 pixels, row by row
+    QFile file(baseName + ".raw");
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    const qint64 size = image.sizeInBytes();
+    return file.write(reinterpret_cast<const char *>(image.constBits()), size) == size;
+}
@@ -0,0 +1,63 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <QImage>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QThread>
+#include <QVector>
+#include <vector>
+
+// Writes rendered frames to numbered image files on a pool of encoder
+// threads. Frames are painted directly into a fixed pool of reusable
+// buffers, so memory is bounded by the pool size; when every buffer is
+// waiting to be encoded, acquireFrame() blocks until one is written out and
+// tryAcquireFrame() drops the frame instead.
+class FrameCapture {
+public:
+    enum Format { PNG, RAW };
+
+    FrameCapture(const QSize &frameSize, int poolSize);
+    ~FrameCapture();
+
+    bool start(const QString &directory, Format format, int encoderCount);
+    void finish();
+
+    // Returns a free buffer to paint into, waiting for one if necessary.
+    // Every acquired buffer must be handed back with submitFrame().
+    QImage *acquireFrame();
+    // Returns nullptr and counts the frame as dropped when no buffer is free
+    QImage *tryAcquireFrame();
+    void submitFrame(QImage *frame);
+
+    int framesSubmitted() const;
+    int framesFailed() const;
+    int framesDropped() const;
+
+private:
+    struct QueuedFrame {
+        int number;
+        int slot;
+    };
+
+    void encodeLoop();
+    bool writeFrame(const QImage &image, int number) const;
+
+    std::vector<QImage> pool;
+    QString directory;
+    Format format;
+
+    mutable QMutex mutex;
+    QWaitCondition slotFreed;
+    QWaitCondition frameQueued;
+    QVector<int> freeSlots;
+    QQueue<QueuedFrame> queue;
+    QVector<QThread *> encoders;
+    int nextFrameNumber;
+    int failedFrames;
+    int droppedFrames;
+    bool stopping;
+};
+
+#endif // FRAMECAPTURE_H
@@ -0,0 +1,58 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include <QtGlobal>
+#include <atomic>
+
+struct InputEvent {
+    qint64 timeNs; // game clock when the event was received
+    int key;
+};
+
+// Fixed-capacity single-producer/single-consumer ring buffer. Neither side
+// blocks or allocates, so input can be handed to the simulation from any
+// one thread. A full queue rejects new events.
+template <unsigned Capacity>
+class InputQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side
+    bool push(const InputEvent &event)
+    {
+        const unsigned tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headIndex.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        events[tail & (Capacity - 1)] = event;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: oldest event, or nullptr when empty
+    const InputEvent *front() const
+    {
+        const unsigned head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &events[head & (Capacity - 1)];
+    }
+
+    void pop()
+    {
+        headIndex.store(headIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void clear()
+    {
+        headIndex.store(tailIndex.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    InputEvent events[Capacity];
+    std::atomic<unsigned> headIndex{0};
+    std::atomic<unsigned> tailIndex{0};
+};
+
+#endif // INPUTQUEUE_H
@@ -0,0 +1,167 @@
+// Generates random cactus sequences with the game's spawn timing and checks
+// every obstacle against the precomputed jump envelope. Like
+// DinoRunGame::updateCacti(), the spawn threshold counts as re-drawn on
+// every tick, so gaps bunch up near the minimum delay. Sequences are not
+// corrected the way DinoRunGame::generateCactus() does, so the output shows
+// how often the raw spawn rule would produce an impossible run. It also
+// checks that every cactus stays clearable whatever first step a jump gets.
+//
+// Usage: JumpCheck [sequences] [length]
+
+#include "DinoPhysics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace DinoPhysics;
+
+// Spawn threshold range used by DinoRunGame::updateCacti()
+const int SPAWN_MIN_MS = 1200;
+const int SPAWN_RANGE_MS = 1800;
+constexpr int SPEED_LEVELS =
+        static_cast<int>((MAX_GAME_SPEED - INITIAL_GAME_SPEED) / SPEED_INCREMENT) + 1;
+
+// DinoRunGame::updateCacti() spawns on the first tick whose elapsed time
+// exceeds a threshold drawn afresh on that tick. Weight k is the chance that
+// this happens exactly k ticks after the previous spawn, so sampling it is
+// equivalent to re-drawing the threshold every tick.
+std::vector<double> spawnTickWeights()
+{
+    std::vector<double> weights(1, 0.0);
+    double notYet = 1.0;
+    for (int tick = 1; notYet > 0.0; ++tick) {
+        const int below = std::min(std::max(tick * TICK_MS - SPAWN_MIN_MS, 0), SPAWN_RANGE_MS);
+        const double chance = double(below) / SPAWN_RANGE_MS;
+        weights.push_back(notYet * chance);
+        notYet = chance < 1.0 ? notYet * (1.0 - chance) : 0.0;
+    }
+    return weights;
+}
+
+// Jumps applied part-way through a tick integrate between 0 and
+// MAX_FIRST_STEP ticks on their first step. Returns how many evenly spaced
+// first steps leave some cactus unclearable at the given cactus step.
+int countUnclearableFirstSteps(int samples, int step)
+{
+    int unclearable = 0;
+    for (int i = 0; i <= samples; ++i) {
+        if (!allCactiClearable(computeJumpArc(MAX_FIRST_STEP * i / samples), step)) {
+            ++unclearable;
+        }
+    }
+    return unclearable;
+}
+
+struct Result {
+    unsigned long long sequences = 0;
+    unsigned long long unfairSequences = 0;
+    unsigned long long unclearable = 0;   // obstacle too tall or wide for the speed
+    unsigned long long gapTooShort = 0;   // clearable alone, not after the previous one
+    unsigned long long unfairBySpeed[SPEED_LEVELS] = {};
+};
+
+void validate(Result &result, unsigned long long sequences, int length, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> typeDist(0, CACTUS_TYPES - 1);
+    const std::vector<double> weights = spawnTickWeights();
+    std::discrete_distribution<int> spawnTickDist(weights.begin(), weights.end());
+    std::uniform_int_distribution<int> speedDist(0, SPEED_LEVELS - 1);
+
+    for (unsigned long long n = 0; n < sequences; ++n) {
+        const int level = speedDist(rng);
+        const int step = cactusStep(INITIAL_GAME_SPEED + level * SPEED_INCREMENT);
+
+        Obstacle previous = cactusObstacle(typeDist(rng));
+        bool fair = canClear(previous, step);
+        if (!fair) {
+            ++result.unclearable;
+        }
+
+        for (int i = 1; i < length && fair; ++i) {
+            const Obstacle next = cactusObstacle(typeDist(rng));
+            // Cacti enter at the same x, so the gap between leading edges is
+            // how far the previous one moved until the next spawn
+            const int distance = spawnTickDist(rng) * step;
+
+            if (!canClear(next, step)) {
+                ++result.unclearable;
+                fair = false;
+            } else if (!isFairFollowUp(previous, next, distance, step)) {
+                ++result.gapTooShort;
+                fair = false;
+            }
+            previous = next;
+        }
+
+        ++result.sequences;
+        if (!fair) {
+            ++result.unfairSequences;
+            ++result.unfairBySpeed[level];
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    const unsigned long long sequences = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000ULL;
+    const int length = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    // A smaller step leaves more ticks above the cactus, so the slowest
+    // speed is the binding case
+    const int firstStepSamples = 65536;
+    const int unclearableFirstSteps =
+            countUnclearableFirstSteps(firstStepSamples, cactusStep(INITIAL_GAME_SPEED));
+
+    const unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Result> partials(threadCount);
+    std::vector<std::thread> workers;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threadCount; ++t) {
+        const unsigned long long share = sequences / threadCount + (t < sequences % threadCount ? 1 : 0);
+        workers.emplace_back(validate, std::ref(partials[t]), share, length, 12345u + t);
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Result total;
+    for (const Result &partial : partials) {
+        total.sequences += partial.sequences;
+        total.unfairSequences += partial.unfairSequences;
+        total.unclearable += partial.unclearable;
+        total.gapTooShort += partial.gapTooShort;
+        for (int level = 0; level < SPEED_LEVELS; ++level) {
+            total.unfairBySpeed[level] += partial.unfairBySpeed[level];
+        }
+    }
+
+    std::printf("jump arc:        %d ticks, apex %d px\n", JUMP_ARC.airTicks, JUMP_ARC.apex);
+    std::printf("first steps:     %d of %d samples in [0, %.3f] unclearable\n",
+                unclearableFirstSteps, firstStepSamples + 1, MAX_FIRST_STEP);
+    std::printf("sequences:       %llu x %d cacti on %u threads\n", total.sequences, length, threadCount);
+    std::printf("throughput:      %.2f M sequences/s\n", total.sequences / seconds / 1.0e6);
+    std::printf("unfair:          %llu (%.4f%%)\n", total.unfairSequences,
+                total.sequences ? 100.0 * total.unfairSequences / total.sequences : 0.0);
+    std::printf("  unclearable:   %llu\n", total.unclearable);
+    std::printf("  gap too short: %llu\n", total.gapTooShort);
+
+    std::printf("\nUnfair sequences by game speed\n");
+    for (int level = 0; level < SPEED_LEVELS; ++level) {
+        std::printf("  %5.1f  %llu\n", INITIAL_GAME_SPEED + level * SPEED_INCREMENT,
+                    total.unfairBySpeed[level]);
+    }
+
+    return total.unfairSequences || unclearableFirstSteps ? 1 : 0;
+}
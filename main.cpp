@@ -1,11 +1,84 @@
 #include "DinoRunGame.h"
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Dino Run Game");
+    parser.addHelpOption();
+
+    QCommandLineOption renderScaleOption("render-scale",
+        "Internal render resolution relative to 800x450 (0.5 to 4), or \"auto\" "
+        "to follow the window size and frame time.", "scale", "auto");
+    parser.addOption(renderScaleOption);
+
+    QCommandLineOption traceOption("trace",
+        "Write a per-tick gameplay trace to <file> for analysis with DinoTrace.", "file");
+    parser.addOption(traceOption);
+
+    QCommandLineOption benchmarkOption("benchmark",
+        "Print time to first frame, frame timings and jump input latency on exit.");
+    parser.addOption(benchmarkOption);
+
+    QCommandLineOption captureOption("capture",
+        "Save every simulation frame as an image in <directory>. Without "
+        "--capture-fast, frames the encoders cannot keep up with are dropped.", "directory");
+    parser.addOption(captureOption);
+    QCommandLineOption captureFormatOption("capture-format",
+        "Captured frame format: png (default) or raw (ARGB32 pixels).", "format", "png");
+    parser.addOption(captureFormatOption);
+    QCommandLineOption captureFramesOption("capture-frames",
+        "Stop capturing after <n> frames.", "n", "0");
+    parser.addOption(captureFramesOption);
+    QCommandLineOption captureFastOption("capture-fast",
+        "Start the run immediately and simulate it as fast as frames can be "
+        "encoded, then quit. Combine with -platform offscreen for headless use.");
+    parser.addOption(captureFastOption);
+    parser.process(app);
+
+    // Without a capture these would leave a headless run idling forever
+    if (!parser.isSet(captureOption)
+        && (parser.isSet(captureFastOption) || parser.isSet(captureFramesOption)
+            || parser.isSet(captureFormatOption))) {
+        qCritical("--capture-fast, --capture-frames and --capture-format require "
+                  "--capture <directory>");
+        return 1;
+    }
+
     DinoRunGame game;
+    game.setBenchmark(parser.isSet(benchmarkOption));
+
+    const QString renderScale = parser.value(renderScaleOption);
+    if (renderScale != "auto") {
+        bool ok = false;
+        const qreal scale = renderScale.toDouble(&ok);
+        if (!ok || scale <= 0.0) {
+            qWarning("Invalid render scale \"%s\", using auto", qPrintable(renderScale));
+        } else {
+            game.setRenderScale(scale);
+        }
+    }
+
+    if (parser.isSet(traceOption) && !game.startTrace(parser.value(traceOption))) {
+        qWarning("Cannot write trace file \"%s\"", qPrintable(parser.value(traceOption)));
+    }
+
+    if (parser.isSet(captureOption)) {
+        const FrameCapture::Format format = parser.value(captureFormatOption) == "raw"
+                ? FrameCapture::RAW : FrameCapture::PNG;
+        if (!game.startCapture(parser.value(captureOption), format,
+                               parser.value(captureFramesOption).toInt(),
+                               parser.isSet(captureFastOption))) {
+            qWarning("Cannot write frames to \"%s\"", qPrintable(parser.value(captureOption)));
+            if (parser.isSet(captureFastOption)) {
+                return 1;
+            }
+        }
+    }
+
     game.show();
 
     return app.exec();